@@ -1,5 +1,8 @@
 #include "device.h"
 
+// proto_credits() liczy miejsce w TX dla odpowiedzi o rozmiarze PROTO_REPLY_MAX_PAYLOAD.
+_Static_assert(DEVICE_STAT_LEN <= PROTO_REPLY_MAX_PAYLOAD, "STAT payload exceeds PROTO_REPLY_MAX_PAYLOAD");
+
 // Ogranicza wartość typu uint8_t do przedziału [lo, hi].
 static uint8_t clamp_u8(uint8_t v, uint8_t lo, uint8_t hi){
     if (v < lo) return lo;
@@ -34,6 +37,7 @@ proto_reason_t device_handle_cmd(device_t* d, uint8_t cmd, const uint8_t* payloa
             return PROTO_REASON_OK;
 
         case PROTO_CMD_GET_STAT:
+        case PROTO_CMD_GET_CREDIT:
             if (payload_len != 0u) return PROTO_REASON_BAD_PAYLOAD;
             return PROTO_REASON_OK;
 
@@ -60,10 +64,10 @@ uint8_t device_pack_stat(
     // Layout (little-endian):
     // speed:u8, mode:u8, last_error:u8, reserved:u8,
     // ticks:u32, rx_dropped:u32, broken_frames:u32, crc_errors:u32,
-    // last_cmd_latency_ms:u32
+    // last_cmd_latency_ms:u32, resp_deferred:u32, resp_dropped:u32
 
     // Sprawdź, czy mamy wystarczająco miejsca w buforze wyjściowym.
-    const uint8_t need = 4u + 4u * 5u;  // Wymagane 24 bajty łącznie
+    const uint8_t need = DEVICE_STAT_LEN;  // Wymagane 32 bajty łącznie
     if (out_cap < need) return 0;       // Brak miejsca. Zwróć 0, aby wskazać błąd. 
 
     out[0] = d->speed;
@@ -76,6 +80,8 @@ uint8_t device_pack_stat(
     wr_u32_le(&out[12], pstats->broken_frames);
     wr_u32_le(&out[16], pstats->crc_errors);
     wr_u32_le(&out[20], pstats->last_cmd_latency_ms);
+    wr_u32_le(&out[24], pstats->resp_deferred);
+    wr_u32_le(&out[28], pstats->resp_dropped);
 
     return need;
 }
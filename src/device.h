@@ -13,6 +13,9 @@ typedef struct {
     device_mode_t mode;
 } device_t;
 
+// Rozmiar payloadu STAT (4 bajty stanu + 7 liczników u32). Musi mieścić się w PROTO_REPLY_MAX_PAYLOAD.
+#define DEVICE_STAT_LEN (4u + 4u * 7u)
+
 // Inicjalizacja stanu urządzenia.
 void device_init(device_t* d);
 
@@ -0,0 +1,82 @@
+#include "fleet.h"
+#include <stdlib.h>
+
+// Inicjalizacja floty n urządzeń (alokuje tablice). Zwraca 1 w przypadku sukcesu, 0 przy braku pamięci.
+int fleet_init(fleet_t* f, size_t n){
+    f->n = n;
+    f->ticks = 0;
+    f->setpoint = calloc(n, sizeof(*f->setpoint));
+    f->mode = calloc(n, sizeof(*f->mode));
+    // Dopełnienie do FLEET_LANES: dodatkowe urządzenia stoją w miejscu (cel = prędkość = 0).
+    const size_t n_pad = (n + FLEET_LANES - 1u) & ~(size_t)(FLEET_LANES - 1u);
+    f->target_q8 = calloc(n_pad, sizeof(*f->target_q8));
+    f->speed_q8 = calloc(n_pad, sizeof(*f->speed_q8));
+    if (!f->setpoint || !f->mode || !f->target_q8 || !f->speed_q8){
+        fleet_free(f);
+        return 0;
+    }
+    // calloc: setpoint=0, mode=DEVICE_MODE_OPEN, speed=0 — jak device_init().
+    return 1;
+}
+// Zwolnienie tablic floty.
+void fleet_free(fleet_t* f){
+    free(f->setpoint);
+    free(f->mode);
+    free(f->target_q8);
+    free(f->speed_q8);
+    f->setpoint = NULL;
+    f->mode = NULL;
+    f->target_q8 = NULL;
+    f->speed_q8 = NULL;
+    f->n = 0;
+}
+// Czy idx wskazuje urządzenie floty (wspólna reguła dla komend i STAT).
+static int fleet_idx_ok(const fleet_t* f, size_t idx){
+    return idx < f->n;
+}
+// Wykonaj komendę dla urządzenia idx (< n) przez device_handle_cmd (zmienia setpoint/mode, nie prędkość).
+proto_reason_t fleet_handle_cmd(fleet_t* f, size_t idx, uint8_t cmd, const uint8_t* payload, uint8_t payload_len){
+    if (!fleet_idx_ok(f, idx)) return PROTO_REASON_BAD_PAYLOAD;
+    device_t d;
+    d.speed = f->setpoint[idx];
+    d.mode = (device_mode_t)f->mode[idx];
+    proto_reason_t r = device_handle_cmd(&d, cmd, payload, payload_len);
+    f->setpoint[idx] = d.speed;
+    f->mode[idx] = (uint8_t)d.mode;
+    // Zależność od trybu liczymy tu, raz na komendę: OPEN dąży do setpoint, CLOSED hamuje do zera.
+    f->target_q8[idx] = (d.mode == DEVICE_MODE_OPEN) ? (int16_t)(d.speed << FLEET_Q) : 0;
+    return r;
+}
+// Kernel ticku: jeden typ (int16_t), bez rozgałęzień i aliasowania. Liczba iteracji jest
+// wielokrotnością FLEET_LANES, więc przy -O2 (model kosztów "very cheap") GCC zastępuje pętlę
+// w całości kodem wektorowym — nie potrzebuje końcówki skalarnej.
+static void fleet_kernel(size_t n_pad, const int16_t* restrict target_q8, int16_t* restrict speed_q8){
+    n_pad &= ~(size_t)(FLEET_LANES - 1u);
+    for (size_t i = 0; i < n_pad; i++){
+        // Przyspieszenie ograniczone przez FLEET_RAMP_UP_Q8, zwalnianie przez FLEET_BRAKE_Q8.
+        int16_t diff = (int16_t)(target_q8[i] - speed_q8[i]);
+        diff = diff > FLEET_RAMP_UP_Q8 ? FLEET_RAMP_UP_Q8 : diff;
+        diff = diff < -FLEET_BRAKE_Q8 ? -FLEET_BRAKE_Q8 : diff;
+        speed_q8[i] = (int16_t)(speed_q8[i] + diff);
+    }
+}
+// Jeden tick symulacji: wszystkie urządzenia dążą do celu ramp.
+void fleet_tick(fleet_t* f){
+    f->ticks++;
+    fleet_kernel(f->n + FLEET_LANES - 1u, f->target_q8, f->speed_q8);
+}
+// Pakuje stan urządzenia idx do bufora STAT przez device_pack_stat (speed = aktualna prędkość).
+uint8_t fleet_pack_stat(
+    const fleet_t* f,
+    size_t idx,
+    uint32_t rx_dropped,
+    const proto_stats_t* pstats,
+    uint8_t* out,
+    uint8_t out_cap
+){
+    if (!fleet_idx_ok(f, idx)) return 0;
+    device_t d;
+    d.speed = (uint8_t)(f->speed_q8[idx] >> FLEET_Q);
+    d.mode = (device_mode_t)f->mode[idx];
+    return device_pack_stat(&d, f->ticks, rx_dropped, pstats, out, out_cap);
+}
@@ -0,0 +1,55 @@
+#pragma once
+#include <stdint.h>
+#include <stddef.h>
+#include "protocol.h"
+#include "device.h"
+
+// Prędkości w formacie stałoprzecinkowym Q8.8 (0..100 -> 0..25600, mieści się w int16_t).
+#define FLEET_Q 8u
+// Tablice pętli ticku są dopełniane do wielokrotności tej liczby urządzeń (pełne wektory bez końcówki).
+#define FLEET_LANES 16u
+
+// Narastanie prędkości w trybie OPEN (Q8.8 na tick): 0..100 w 200 tickach.
+#ifndef FLEET_RAMP_UP_Q8
+#define FLEET_RAMP_UP_Q8 128
+#endif
+// Każde zwalnianie (CLOSED, STOP, niższy setpoint) (Q8.8 na tick): 100..0 w 50 tickach.
+#ifndef FLEET_BRAKE_Q8
+#define FLEET_BRAKE_Q8 512
+#endif
+
+// Flota symulowanych urządzeń w układzie struktur tablic (SoA):
+// każde pole to osobna, ciągła tablica. Pętla ticku dotyka tylko target_q8 i speed_q8
+// (4 bajty na urządzenie; ten sam typ, bez poszerzania — GCC wektoryzuje ją już przy -O2).
+typedef struct {
+    size_t n;
+    uint8_t*  setpoint;   // zadana prędkość 0..100 (ustawiana komendami)
+    uint8_t*  mode;       // device_mode_t
+    int16_t*  target_q8;  // cel ramp (Q8.8): setpoint w trybie OPEN, 0 w CLOSED
+    int16_t*  speed_q8;   // aktualna prędkość (Q8.8), raportowana w STAT
+    uint32_t ticks;
+} fleet_t;
+
+// Inicjalizacja floty n urządzeń (alokuje tablice). Zwraca 1 w przypadku sukcesu, 0 przy braku pamięci.
+int fleet_init(fleet_t* f, size_t n);
+// Zwolnienie tablic floty.
+void fleet_free(fleet_t* f);
+
+// Wykonaj komendę dla urządzenia idx (< n) przez device_handle_cmd (zmienia setpoint/mode, nie prędkość).
+// Dla idx >= n zwraca PROTO_REASON_BAD_PAYLOAD bez zmiany stanu — indeks urządzenia traktujemy jak
+// adres w payloadzie komendy, więc host dostaje ten sam NACK co przy złym argumencie.
+proto_reason_t fleet_handle_cmd(fleet_t* f, size_t idx, uint8_t cmd, const uint8_t* payload, uint8_t payload_len);
+
+// Jeden tick symulacji: wszystkie urządzenia dążą do celu ramp.
+void fleet_tick(fleet_t* f);
+
+// Pakuje stan urządzenia idx do bufora STAT przez device_pack_stat (speed = aktualna prędkość).
+// Zwraca 0 dla idx >= n (jak przy braku miejsca w buforze).
+uint8_t fleet_pack_stat(
+    const fleet_t* f,
+    size_t idx,
+    uint32_t rx_dropped,
+    const proto_stats_t* pstats,
+    uint8_t* out,
+    uint8_t out_cap
+);
@@ -1,42 +1,14 @@
 #include <stdio.h>
-#include <string.h>
+#include <time.h>
 #include "shell.h"
+#include "fleet.h"
 
-// Pomocnicza funkcja do obliczania CRC-8.
-static uint8_t crc8_update(uint8_t crc, uint8_t data){
-    crc ^= data;
-    for (unsigned i = 0; i < 8; i++){
-        crc = (crc & 0x80u) ? (uint8_t)((crc << 1) ^ 0x07u) : (uint8_t)(crc << 1);
-    }
-    return crc;
-}
-
-// Funkcja do obliczania CRC-8 dla ramki.
-static uint8_t crc8_compute(uint8_t len, const uint8_t* data){
-    uint8_t crc = 0;
-    crc = crc8_update(crc, len);
-    for (uint8_t i = 0; i < len; i++) crc = crc8_update(crc, data[i]);
-    return crc;
-}
-// Buduje ramkę protokołu w podanym buforze wyjściowym.
-static size_t build_frame(uint8_t cmd, const uint8_t* payload, uint8_t payload_len, uint8_t* out, size_t out_cap){
-    // STX|LEN|CMD|PAYLOAD|CRC
-    const size_t total = (size_t)(1u + 1u + 1u + payload_len + 1u);
-    if (out_cap < total) return 0;
-    out[0] = PROTO_STX;
-    out[1] = (uint8_t)(1u + payload_len);
-    out[2] = cmd;
-    if (payload_len) memcpy(&out[3], payload, payload_len);
-    const uint8_t crc = crc8_compute(out[1], &out[2]);
-    out[3u + payload_len] = crc;
-    return total;
-}
 // Wstrzyknięcie ramki do powłoki (symulacja przychodzących danych).
 static void inject_frame(shell_t* sh, uint8_t cmd, const uint8_t* payload, uint8_t payload_len, int corrupt_crc){
     uint8_t buf[128];
-    size_t n = build_frame(cmd, payload, payload_len, buf, sizeof(buf));
+    size_t n = proto_encode(cmd, payload, payload_len, buf, sizeof(buf));
     if (!n){
-        printf("INFO: build_frame failed\n");
+        printf("INFO: proto_encode failed\n");
         return;
     }
     if (corrupt_crc) buf[n - 1] ^= 0xFFu;
@@ -49,6 +21,26 @@ static void inject_partial(shell_t* sh, const uint8_t* bytes, size_t len){
     printf("INFO: inject partial bytes=%zu\n", len);
     shell_rx_bytes(sh, bytes, len);
 }
+// Dekoder po stronie hosta (scenariusz z kredytami): ten sam FSM, bez TX.
+static rb_t host_rx;
+static proto_t host_proto;
+// Odbiorca TX powłoki: przekazuje bajty do dekodera hosta i wypisuje je jak shell_tick().
+static void capture_tx(void* ctx, const uint8_t* data, size_t len){
+    (void)ctx;
+    printf("TX: ");
+    for (size_t i = 0; i < len; i++){
+        printf("%02X ", data[i]);
+        (void)rb_put(&host_rx, data[i]);
+    }
+    putchar('\n');
+}
+// Odebrana przez hosta ramka: zapamiętuje wartość z ostatniej ramki CREDIT.
+static void on_host_msg(void* ctx, const proto_msg_t* msg, uint32_t rx_frame_start_ms, uint32_t rx_frame_end_ms){
+    int* credits = (int*)ctx;
+    (void)rx_frame_start_ms;
+    (void)rx_frame_end_ms;
+    if (msg->cmd == PROTO_CMD_CREDIT && msg->payload_len == 1u) *credits = msg->payload[0];
+}
 // Uruchomienie określonej liczby "ticków" powłoki.
 static void run_ticks(shell_t* sh, int n){
     for (int i = 0; i < n; i++) shell_tick(sh);
@@ -56,12 +48,14 @@ static void run_ticks(shell_t* sh, int n){
 // Wyświetlanie statystyk powłoki.
 static void print_stats(const shell_t* sh){
     printf(
-        "STATS: ticks=%u rx_dropped=%zu broken_frames=%u crc_errors=%u last_cmd_latency=%ums\n\n",
+        "STATS: ticks=%u rx_dropped=%zu broken_frames=%u crc_errors=%u last_cmd_latency=%ums resp_deferred=%u resp_dropped=%u\n\n",
         sh->ticks,
         sh->rx.dropped,
         sh->proto.stats.broken_frames,
         sh->proto.stats.crc_errors,
-        sh->proto.stats.last_cmd_latency_ms
+        sh->proto.stats.last_cmd_latency_ms,
+        sh->proto.stats.resp_deferred,
+        sh->proto.stats.resp_dropped
     );
 }
 
@@ -127,7 +121,7 @@ int main(void){
         for (int i = 0; i < 200; i++){
             uint8_t speed = (uint8_t)(i % 101);
             uint8_t frame[8];
-            size_t n = build_frame(PROTO_CMD_SET_SPEED, &speed, 1, frame, sizeof(frame));
+            size_t n = proto_encode(PROTO_CMD_SET_SPEED, &speed, 1, frame, sizeof(frame));
             shell_rx_bytes(&sh, frame, n);
         }
         run_ticks(&sh, 200);
@@ -138,5 +132,78 @@ int main(void){
         print_stats(&sh);
     }
 
+    printf("\n=== 4) Pełny TX (kolejka odpowiedzi + kredyty) ===\n\n");
+    {
+        // 20 x GET_STAT w jednym ticku: odpowiedzi STAT nie mieszczą się w TX,
+        // część trafia do kolejki oczekujących, nadmiar jest liczony jako resp_dropped.
+        sh.log_io = 0;
+        for (int i = 0; i < 20; i++){
+            uint8_t frame[8];
+            size_t n = proto_encode(PROTO_CMD_GET_STAT, NULL, 0, frame, sizeof(frame));
+            shell_rx_bytes(&sh, frame, n);
+        }
+        shell_tick(&sh);
+        printf("INFO: pending=%u credits=%u\n", proto_pending(&sh.proto), proto_credits(&sh.proto));
+        run_ticks(&sh, 10);
+        printf("INFO: pending=%u credits=%u\n", proto_pending(&sh.proto), proto_credits(&sh.proto));
+        print_stats(&sh);
+
+        // Host z kontrolą przepływu: pyta o kredyty, dekoduje ramkę CREDIT z TX
+        // i wysyła tylko tyle żądań, ile urządzenie ogłosiło.
+        sh.log_io = 1;
+        sh.credit_updates = 1;
+        sh.tx_sink = capture_tx;
+        rb_init(&host_rx);
+        proto_init(&host_proto, &host_rx, NULL);
+        inject_frame(&sh, PROTO_CMD_GET_CREDIT, NULL, 0, 0);
+        run_ticks(&sh, 1);
+        sh.tx_sink = NULL;
+        int decoded = -1;
+        proto_poll(&host_proto, sh.now_ms, on_host_msg, NULL, &decoded);
+        if (decoded < 0) printf("INFO: no CREDIT reply\n");
+        uint8_t credits = decoded < 0 ? 0u : (uint8_t)decoded;
+        printf("INFO: host credits=%u\n", credits);
+        sh.log_io = 0;
+        for (uint8_t i = 0; i < credits; i++){
+            uint8_t frame[8];
+            size_t n = proto_encode(PROTO_CMD_GET_STAT, NULL, 0, frame, sizeof(frame));
+            shell_rx_bytes(&sh, frame, n);
+        }
+        run_ticks(&sh, 10);
+        sh.log_io = 1;
+        inject_frame(&sh, PROTO_CMD_GET_STAT, NULL, 0, 0);
+        run_ticks(&sh, 5);
+        print_stats(&sh);
+    }
+
+    printf("\n=== 5) Flota (100k urządzeń, 1000 ticków = 1 s przy 1 kHz) ===\n\n");
+    {
+        fleet_t fl;
+        if (!fleet_init(&fl, 100000u)){
+            printf("INFO: fleet_init failed\n");
+            return 1;
+        }
+        // Komendy przez te same handlery co pojedyncze urządzenie.
+        for (size_t i = 0; i < fl.n; i++){
+            uint8_t speed = (uint8_t)(i % 101u);
+            (void)fleet_handle_cmd(&fl, i, PROTO_CMD_SET_SPEED, &speed, 1);
+        }
+        uint8_t mode = (uint8_t)DEVICE_MODE_CLOSED;
+        (void)fleet_handle_cmd(&fl, 1u, PROTO_CMD_SET_MODE, &mode, 1);
+
+        clock_t t0 = clock();
+        for (int i = 0; i < 1000; i++) fleet_tick(&fl);
+        double sec = (double)(clock() - t0) / CLOCKS_PER_SEC;
+        printf("INFO: fleet n=%zu ticks=%u cpu=%.3fs (%.2f ns/device/tick)\n",
+            fl.n, fl.ticks, sec, sec * 1e9 / ((double)fl.n * 1000.0));
+
+        uint8_t pl[64];
+        uint8_t n = fleet_pack_stat(&fl, 100u, (uint32_t)sh.rx.dropped, &sh.proto.stats, pl, (uint8_t)sizeof(pl));
+        printf("INFO: dev[100] speed=%u mode=%u (STAT %u bytes)\n", pl[0], pl[1], n);
+        n = fleet_pack_stat(&fl, 1u, (uint32_t)sh.rx.dropped, &sh.proto.stats, pl, (uint8_t)sizeof(pl));
+        printf("INFO: dev[1] speed=%u mode=%u (STAT %u bytes)\n", pl[0], pl[1], n);
+        fleet_free(&fl);
+    }
+
     return 0;
 }
@@ -11,12 +11,29 @@ static uint8_t crc8_update(uint8_t crc, uint8_t data){
 }
 
 // Oblicza CRC-8 po bajcie LEN oraz po wszystkich bajtach danych.
-static uint8_t crc8_compute(uint8_t len, const uint8_t* data /* LEN bytes */){
+uint8_t proto_crc8(uint8_t len, const uint8_t* data /* LEN bytes */){
     uint8_t crc = 0;
     crc = crc8_update(crc, len);
     for (uint8_t i = 0; i < len; i++) crc = crc8_update(crc, data[i]);
     return crc;
 }
+// Koduje ramkę do bufora: kopiowanie i CRC w jednym przebiegu po danych.
+size_t proto_encode(uint8_t cmd, const uint8_t* payload, uint8_t payload_len, uint8_t* out, size_t out_cap){
+    // STX|LEN|CMD|PAYLOAD|CRC
+    const size_t total = (size_t)(1u + 1u + 1u + payload_len + 1u);
+    if (payload_len > PROTO_MAX_PAYLOAD || out_cap < total) return 0;
+    const uint8_t len = (uint8_t)(1u + payload_len);
+    out[0] = PROTO_STX;
+    out[1] = len;
+    out[2] = cmd;
+    uint8_t crc = crc8_update(crc8_update(0, len), cmd);
+    for (uint8_t i = 0; i < payload_len; i++){
+        out[3u + i] = payload[i];
+        crc = crc8_update(crc, payload[i]);
+    }
+    out[3u + payload_len] = crc;
+    return total;
+}
 
 // Resetuje stan parsera protokołu do stanu początkowego.
 static void proto_reset(proto_t* p){
@@ -60,28 +77,66 @@ int proto_send(proto_t* p, uint8_t cmd, const uint8_t* payload, uint8_t payload_
     if (payload_len > PROTO_MAX_PAYLOAD) return 0;
     if (!tx_can_fit_frame(p, payload_len)) return 0;
 
-    uint8_t len = (uint8_t)(1u + payload_len);
-    uint8_t data[1u + PROTO_MAX_PAYLOAD];
-    data[0] = cmd;
-    if (payload_len) memcpy(&data[1], payload, payload_len);
-    uint8_t crc = crc8_compute(len, data);
-
     // Kolejność: STX | LEN | CMD | PAYLOAD | CRC
-    (void)rb_put(p->tx, PROTO_STX);
-    (void)rb_put(p->tx, len);
-    for (uint8_t i = 0; i < len; i++) (void)rb_put(p->tx, data[i]);
-    (void)rb_put(p->tx, crc);
+    uint8_t frame[1u + 1u + 1u + PROTO_MAX_PAYLOAD + 1u];
+    size_t n = proto_encode(cmd, payload, payload_len, frame, sizeof(frame));
+    for (size_t i = 0; i < n; i++) (void)rb_put(p->tx, frame[i]);
+    return 1;
+}
+// Przenosi oczekujące odpowiedzi do bufora TX, dopóki mieszczą się w całości. Zwraca liczbę wysłanych ramek.
+uint8_t proto_flush(proto_t* p){
+    proto_txq_t* q = &p->txq;
+    uint8_t sent = 0;
+    while (q->count > 0){
+        const proto_msg_t* m = &q->slot[q->head];
+        if (!proto_send(p, m->cmd, m->payload, m->payload_len)) break;
+        q->head = (uint8_t)((q->head + 1u) % PROTO_TXQ_LEN);
+        q->count--;
+        sent++;
+    }
+    return sent;
+}
+// Wysyłka odpowiedzi z gwarancją kolejności (bezpośrednio do TX lub przez kolejkę oczekujących).
+int proto_reply(proto_t* p, uint8_t cmd, const uint8_t* payload, uint8_t payload_len){
+    if (payload_len > PROTO_MAX_PAYLOAD) return 0;
+    // Najpierw starsze odpowiedzi — nowa ramka nie może ich wyprzedzić.
+    (void)proto_flush(p);
+    if (p->txq.count == 0 && proto_send(p, cmd, payload, payload_len)) return 1;
+
+    proto_txq_t* q = &p->txq;
+    if (q->count >= PROTO_TXQ_LEN){
+        p->stats.resp_dropped++;  // polityka: odrzucamy NOWE odpowiedzi
+        return 0;
+    }
+    proto_msg_t* m = &q->slot[(q->head + q->count) % PROTO_TXQ_LEN];
+    m->cmd = cmd;
+    m->payload_len = payload_len;
+    if (payload_len) memcpy(m->payload, payload, payload_len);
+    q->count++;
+    p->stats.resp_deferred++;
     return 1;
 }
-// Nieblokująca wysyłka ACK dla podanej oryginalnej komendy.
+// Liczba odpowiedzi oczekujących w kolejce.
+uint8_t proto_pending(const proto_t* p){
+    return p->txq.count;
+}
+// Kredyty dla hosta: każde żądanie daje dokładnie jedną odpowiedź, a każda odpowiedź zmieści się
+// w wolnym slocie kolejki. Przy pustej kolejce odpowiedzi trafiają prosto do TX, więc doliczamy
+// ramki największej odpowiedzi, które mieszczą się w wolnym miejscu TX.
+uint8_t proto_credits(const proto_t* p){
+    size_t credits = PROTO_TXQ_LEN - p->txq.count;
+    if (p->txq.count == 0) credits += rb_free(p->tx) / (1u + 1u + 1u + PROTO_REPLY_MAX_PAYLOAD + 1u);
+    return (uint8_t)(credits > 255u ? 255u : credits);
+}
+// Wysyłka ACK dla podanej oryginalnej komendy (przez kolejkę odpowiedzi).
 int proto_send_ack(proto_t* p, uint8_t orig_cmd){
     uint8_t pl[1] = { orig_cmd };
-    return proto_send(p, PROTO_CMD_ACK, pl, 1);
+    return proto_reply(p, PROTO_CMD_ACK, pl, 1);
 }
-// Nieblokująca wysyłka NACK dla podanej oryginalnej komendy i powodu błędu.
+// Wysyłka NACK dla podanej oryginalnej komendy i powodu błędu (przez kolejkę odpowiedzi).
 int proto_send_nack(proto_t* p, uint8_t orig_cmd, proto_reason_t reason){
     uint8_t pl[2] = { orig_cmd, (uint8_t)reason };
-    return proto_send(p, PROTO_CMD_NACK, pl, 2);
+    return proto_reply(p, PROTO_CMD_NACK, pl, 2);
 }
 // Dostarcza poprawnie zdekodowaną wiadomość do callbacka.
 static void proto_deliver_msg(proto_t* p, proto_on_msg_fn on_msg, void* ctx, uint32_t rx_start_ms, uint32_t rx_end_ms){
@@ -144,13 +199,13 @@ void proto_poll(proto_t* p, uint32_t now_ms, proto_on_msg_fn on_msg, proto_on_er
             uint32_t rx_start_ms = p->frame_start_ms;
             uint32_t rx_end_ms = now_ms;
 
-            uint8_t expected = crc8_compute(p->len, p->data);
+            uint8_t expected = proto_crc8(p->len, p->data);
             if (b != expected){
                 p->stats.crc_errors++;
                 proto_note_error(p, PROTO_REASON_CRC);
                 if (on_err) on_err(ctx, PROTO_REASON_CRC, p->data[0]);
-                // Best-effort: NACK with cmd we did parse.
-                (void)proto_send_nack(p, p->data[0], PROTO_REASON_CRC);
+                // Best-effort: NACK with cmd we did parse (tylko gdy mamy TX — dekoder hosta go nie ma).
+                if (p->tx) (void)proto_send_nack(p, p->data[0], PROTO_REASON_CRC);
                 proto_reset(p);
                 continue;
             }
@@ -172,9 +227,11 @@ const char* proto_cmd_name(uint8_t cmd){
         case PROTO_CMD_SET_MODE:  return "MODE";
         case PROTO_CMD_STOP:      return "STOP";
         case PROTO_CMD_GET_STAT:  return "GET_STAT";
+        case PROTO_CMD_GET_CREDIT: return "GET_CREDIT";
         case PROTO_CMD_ACK:       return "ACK";
         case PROTO_CMD_NACK:      return "NACK";
         case PROTO_CMD_STAT:      return "STAT";
+        case PROTO_CMD_CREDIT:    return "CREDIT";
         default:                  return "CMD_UNKNOWN";
     }
 }
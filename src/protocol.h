@@ -23,16 +23,26 @@
 #ifndef PROTO_FRAME_TIMEOUT_MS
 #define PROTO_FRAME_TIMEOUT_MS 200u
 #endif
+// Pojemność kolejki odpowiedzi oczekujących na miejsce w buforze TX
+#ifndef PROTO_TXQ_LEN
+#define PROTO_TXQ_LEN 8u
+#endif
+// Największy payload odpowiedzi (STAT, DEVICE_STAT_LEN — pilnuje tego _Static_assert w device.c)
+#ifndef PROTO_REPLY_MAX_PAYLOAD
+#define PROTO_REPLY_MAX_PAYLOAD 32u
+#endif
 // Definicje komend protokołu.
 typedef enum {
     PROTO_CMD_SET_SPEED = 0x01,
     PROTO_CMD_SET_MODE  = 0x02,
     PROTO_CMD_STOP      = 0x03,
     PROTO_CMD_GET_STAT  = 0x04,
+    PROTO_CMD_GET_CREDIT = 0x05,
 
-    PROTO_CMD_ACK  = 0x80,
-    PROTO_CMD_NACK = 0x81,
-    PROTO_CMD_STAT = 0x82,
+    PROTO_CMD_ACK    = 0x80,
+    PROTO_CMD_NACK   = 0x81,
+    PROTO_CMD_STAT   = 0x82,
+    PROTO_CMD_CREDIT = 0x83,
 } proto_cmd_t;
 // Definicje NACK (błędów protokołu).
 typedef enum {
@@ -54,6 +64,8 @@ typedef struct {
     uint32_t crc_errors;
     uint32_t frame_timeouts;
     uint32_t last_cmd_latency_ms;
+    uint32_t resp_deferred;    // odpowiedzi odłożone do kolejki (TX pełny)
+    uint32_t resp_dropped;     // odpowiedzi utracone (kolejka pełna)
     proto_reason_t last_error;
 } proto_stats_t;
 // Struktura reprezentująca wiadomość protokołu.
@@ -62,6 +74,11 @@ typedef struct {
     uint8_t payload[PROTO_MAX_PAYLOAD];
     uint8_t payload_len;
 } proto_msg_t;
+// Kolejka odpowiedzi czekających na miejsce w buforze TX (FIFO).
+typedef struct {
+    proto_msg_t slot[PROTO_TXQ_LEN];
+    uint8_t head, count;
+} proto_txq_t;
 // Struktura reprezentująca stan protokołu.
 typedef struct {
     // IO
@@ -84,22 +101,44 @@ typedef struct {
     uint32_t frame_start_ms;
     uint32_t last_byte_ms;
 
+    // Odpowiedzi odłożone do czasu zwolnienia miejsca w TX
+    proto_txq_t txq;
+
     proto_stats_t stats;
 } proto_t;
 // Typy funkcji callback używanych przez proto_poll().
 typedef void (*proto_on_msg_fn)(void* ctx, const proto_msg_t* msg, uint32_t rx_frame_start_ms, uint32_t rx_frame_end_ms);
 typedef void (*proto_on_err_fn)(void* ctx, proto_reason_t reason, uint8_t cmd);
 
-// Inicjalizacja struktury protokołu.
+// Inicjalizacja struktury protokołu. tx == NULL: tylko dekodowanie (proto_poll nie wysyła NACK, np. po stronie hosta).
 void proto_init(proto_t* p, rb_t* rx, rb_t* tx);
 
 // Protokół: obsługa timeoutów oraz parsowanie bajtów z bufora RX.
 void proto_poll(proto_t* p, uint32_t now_ms, proto_on_msg_fn on_msg, proto_on_err_fn on_err, void* ctx);
 
+// CRC-8 (poly 0x07, init 0x00) po bajcie LEN oraz LEN bajtach CMD+PAYLOAD.
+uint8_t proto_crc8(uint8_t len, const uint8_t* data);
+
+// Koduje ramkę STX|LEN|CMD|PAYLOAD|CRC do bufora w jednym przebiegu. Zwraca liczbę bajtów lub 0, jeśli brak miejsca.
+size_t proto_encode(uint8_t cmd, const uint8_t* payload, uint8_t payload_len, uint8_t* out, size_t out_cap);
+
 // Nieblokująca wysyłka ramki. Zwraca 1 w przypadku sukcesu, 0 jeśli bufor TX nie mógł pomieścić całej ramki (częściowa ramka NIE jest wysyłana).
 int proto_send(proto_t* p, uint8_t cmd, const uint8_t* payload, uint8_t payload_len);
 
-// Nieblokująca wysyłka ACK dla podanej oryginalnej komendy.
+// Wysyłka odpowiedzi z gwarancją kolejności: jeśli TX jest pełny (lub kolejka nie jest pusta),
+// ramka trafia do kolejki oczekujących. Zwraca 1 gdy odpowiedź przyjęto, 0 gdy kolejka pełna (resp_dropped++).
+int proto_reply(proto_t* p, uint8_t cmd, const uint8_t* payload, uint8_t payload_len);
+
+// Przenosi oczekujące odpowiedzi do bufora TX, dopóki mieszczą się w całości. Zwraca liczbę wysłanych ramek.
+uint8_t proto_flush(proto_t* p);
+
+// Liczba odpowiedzi oczekujących w kolejce.
+uint8_t proto_pending(const proto_t* p);
+
+// Kredyty dla hosta: ile odpowiedzi urządzenie przyjmie teraz bez utraty (wolne sloty kolejki + miejsce w TX).
+uint8_t proto_credits(const proto_t* p);
+
+// Wysyłka ACK dla podanej oryginalnej komendy (przez kolejkę odpowiedzi).
 int proto_send_ack(proto_t* p, uint8_t orig_cmd);
-// Nieblokująca wysyłka NACK dla podanej oryginalnej komendy i powodu błędu.
+// Wysyłka NACK dla podanej oryginalnej komendy i powodu błędu (przez kolejkę odpowiedzi).
 int proto_send_nack(proto_t* p, uint8_t orig_cmd, proto_reason_t reason);
\ No newline at end of file
@@ -7,6 +7,17 @@ static void tx_hex_byte(uint8_t b){
     putchar(hex[(b >> 4) & 0x0F]);
     putchar(hex[b & 0x0F]);
 }
+// Kredyty do ogłoszenia: sama ramka CREDIT zajmuje jedno miejsce na odpowiedź.
+static uint8_t credit_value(const shell_t* sh){
+    uint8_t credits = proto_credits(&sh->proto);
+    return credits > 0u ? (uint8_t)(credits - 1u) : 0u;
+}
+// Wysyła ramkę CREDIT: okno — ile żądań bez odpowiedzi host może mieć, licząc od tej ramki.
+static void send_credit(shell_t* sh){
+    uint8_t credits = credit_value(sh);
+    if (sh->log_io) printf("EVT: CREDIT credits=%u\n", (unsigned)credits);
+    if (proto_reply(&sh->proto, PROTO_CMD_CREDIT, &credits, 1)) sh->credit_advertised = credits;
+}
 // Przetwarzanie ramki protokołu. 
 static void on_msg(void* ctx, const proto_msg_t* msg, uint32_t rx_frame_start_ms, uint32_t rx_frame_end_ms){
     shell_t* sh = (shell_t*)ctx;
@@ -31,7 +42,13 @@ static void on_msg(void* ctx, const proto_msg_t* msg, uint32_t rx_frame_start_ms
             (uint8_t)sizeof(pl)
         );
         if (sh->log_io) printf("EVT: STAT\n");
-        (void)proto_send(&sh->proto, PROTO_CMD_STAT, pl, n);
+        (void)proto_reply(&sh->proto, PROTO_CMD_STAT, pl, n);
+        sh->proto.stats.last_cmd_latency_ms = (rx_frame_end_ms - rx_frame_start_ms);
+        return;
+    }
+    // Obsługa komendy GET_CREDIT.
+    if (msg->cmd == PROTO_CMD_GET_CREDIT){
+        send_credit(sh);
         sh->proto.stats.last_cmd_latency_ms = (rx_frame_end_ms - rx_frame_start_ms);
         return;
     }
@@ -55,6 +72,10 @@ void shell_init(shell_t* sh){
     sh->ms_per_tick = 1;
     sh->ticks = 0;
     sh->log_io = 1;
+    sh->credit_updates = 0;
+    sh->credit_advertised = 0;
+    sh->tx_sink = NULL;
+    sh->tx_sink_ctx = NULL;
     device_init(&sh->dev);
     proto_init(&sh->proto, &sh->rx, &sh->tx);
     printf("INFO: READY\n");
@@ -70,13 +91,25 @@ void shell_tick(shell_t* sh){
     sh->ticks++;
     sh->now_ms += sh->ms_per_tick;
 
+    // Najpierw odpowiedzi odłożone w poprzednich tickach (TX został już opróżniony).
+    (void)proto_flush(&sh->proto);
+    // Wszystkie odebrane żądania mają już odpowiedź przed tą ramką, więc nowe okno obejmuje
+    // tylko żądania jeszcze w drodze — host może je od razu poszerzyć.
+    if (sh->credit_updates && (unsigned)credit_value(sh) >= (unsigned)sh->credit_advertised + SHELL_CREDIT_STEP) send_credit(sh);
+
     proto_poll(&sh->proto, sh->now_ms, on_msg, on_err, sh);
 
     // "wysyłka" (UART) — dla czytelności wypisujemy heksami,
     // ponieważ w urządzeniu byłby to strumień bajtów.
     uint8_t b;
     int any_tx = 0;
-    if (sh->log_io){
+    if (sh->tx_sink){
+        // Łącze do hosta (np. generator obciążenia) — przekazujemy cały bufor naraz.
+        uint8_t buf[RB_SIZE];
+        size_t n = 0;
+        while (rb_get(&sh->tx, &b)) buf[n++] = b;
+        if (n) sh->tx_sink(sh->tx_sink_ctx, buf, n);
+    } else if (sh->log_io){
         if (rb_count(&sh->tx) > 0) { printf("TX: "); any_tx = 1; }
         while (rb_get(&sh->tx, &b)){
             tx_hex_byte(b);
@@ -3,6 +3,14 @@
 #include "protocol.h"
 #include "device.h"
 
+// Próg wysyłki CREDIT bez pytania: o ile kredyty muszą wzrosnąć względem ostatnio ogłoszonych
+#ifndef SHELL_CREDIT_STEP
+#define SHELL_CREDIT_STEP 2u
+#endif
+
+// Odbiorca bajtów TX (symulacja łącza do hosta).
+typedef void (*shell_tx_sink_fn)(void* ctx, const uint8_t* data, size_t len);
+
 // Struktura reprezentująca powłokę.
 typedef struct {
     rb_t rx, tx;
@@ -12,6 +20,10 @@ typedef struct {
     uint32_t ms_per_tick;
     uint32_t ticks;
     int log_io;
+    int credit_updates;    // 1 = wysyłaj CREDIT bez pytania, gdy kredyty wzrosną o SHELL_CREDIT_STEP
+    uint8_t credit_advertised;  // ostatnio wysłana wartość CREDIT
+    shell_tx_sink_fn tx_sink;  // jeśli ustawiony, bajty TX trafiają tutaj zamiast na stdout
+    void* tx_sink_ctx;
 } shell_t;
 
 // Inicjalizacja powłoki
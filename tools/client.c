@@ -0,0 +1,140 @@
+#include "client.h"
+#include <string.h>
+
+// Inicjalizacja klienta (on_reply może być NULL).
+void client_init(client_t* c, client_on_reply_fn on_reply, void* ctx){
+    memset(c, 0, sizeof(*c));
+    rb_init(&c->rx);
+    proto_init(&c->proto, &c->rx, NULL);
+    c->on_reply = on_reply;
+    c->ctx = ctx;
+}
+// Liczba żądań oczekujących na odpowiedź.
+size_t client_outstanding(const client_t* c){
+    return c->out_count;
+}
+// Usuwa najstarsze oczekujące żądanie.
+static void client_pop(client_t* c){
+    c->out_head = (c->out_head + 1u) % CLIENT_MAX_OUTSTANDING;
+    c->out_count--;
+}
+// Koduje kolejne żądania do jednego ciągłego bufora w jednym przebiegu i rejestruje je jako oczekujące.
+size_t client_encode(client_t* c, const proto_msg_t* reqs, size_t n, uint8_t* out, size_t out_cap, size_t* out_len, uint32_t now_ms){
+    size_t used = 0;
+    size_t i = 0;
+    for (; i < n && c->out_count < CLIENT_MAX_OUTSTANDING; i++){
+        size_t k = proto_encode(reqs[i].cmd, reqs[i].payload, reqs[i].payload_len, &out[used], out_cap - used);
+        if (!k) break;
+        used += k;
+        client_req_t* r = &c->outq[(c->out_head + c->out_count) % CLIENT_MAX_OUTSTANDING];
+        r->cmd = reqs[i].cmd;
+        r->corrupt = 0;
+        r->sent_ms = now_ms;
+        c->out_count++;
+    }
+    c->stats.sent += (uint32_t)i;
+    if (out_len) *out_len = used;
+    return i;
+}
+// Oznacza żądanie jako celowo uszkodzone (back = 0: ostatnio zakodowane).
+void client_mark_corrupt(client_t* c, size_t back){
+    if (back >= c->out_count) return;
+    c->outq[(c->out_head + c->out_count - 1u - back) % CLIENT_MAX_OUTSTANDING].corrupt = 1;
+}
+// Czy odpowiedź to NACK:CRC.
+static int is_crc_nack(const proto_msg_t* msg){
+    return msg->cmd == PROTO_CMD_NACK && msg->payload_len >= 2u && msg->payload[1] == (uint8_t)PROTO_REASON_CRC;
+}
+// Czy odpowiedź może być odpowiedzią na dane żądanie.
+static int reply_matches(const client_req_t* req, const proto_msg_t* msg){
+    // Uszkodzona ramka może dostać tylko NACK:CRC (albo nic, gdy urządzenie zgubiło STX).
+    if (req->corrupt) return is_crc_nack(msg);
+    switch (msg->cmd){
+        case PROTO_CMD_ACK:
+            return msg->payload_len >= 1u && msg->payload[0] == req->cmd
+                && req->cmd != PROTO_CMD_GET_STAT && req->cmd != PROTO_CMD_GET_CREDIT;
+        case PROTO_CMD_NACK:
+            // NACK:CRC niesie CMD odczytany z uszkodzonej ramki — nie porównujemy go.
+            if (is_crc_nack(msg)) return 1;
+            return msg->payload_len >= 1u && msg->payload[0] == req->cmd;
+        case PROTO_CMD_STAT:   return req->cmd == PROTO_CMD_GET_STAT;
+        case PROTO_CMD_CREDIT: return req->cmd == PROTO_CMD_GET_CREDIT;
+        default:               return 0;
+    }
+}
+// Usuwa najstarsze żądanie bez odpowiedzi, licząc je jako utracone lub (uszkodzone) pominięte.
+static void client_drop_head(client_t* c){
+    if (c->outq[c->out_head].corrupt) c->stats.skipped++;
+    else c->stats.lost++;
+    client_pop(c);
+}
+// Dopasowanie odpowiedzi: urządzenie odpowiada w kolejności (FIFO), więc szukamy
+// pierwszego pasującego żądania od najstarszego; wcześniejsze uznajemy za utracone.
+static void client_on_msg(void* ctx, const proto_msg_t* msg, uint32_t rx_frame_start_ms, uint32_t rx_frame_end_ms){
+    client_t* c = (client_t*)ctx;
+    (void)rx_frame_start_ms;
+    (void)rx_frame_end_ms;
+
+    size_t k = 0;
+    while (k < c->out_count && !reply_matches(&c->outq[(c->out_head + k) % CLIENT_MAX_OUTSTANDING], msg)) k++;
+    // CREDIT, który nie odpowiada na najstarsze żądanie, to aktualizacja wysłana bez pytania.
+    if (msg->cmd == PROTO_CMD_CREDIT && (k != 0 || c->out_count == 0)){
+        c->stats.credit_updates++;
+        if (c->on_reply) c->on_reply(c->ctx, NULL, msg, 0);
+        return;
+    }
+    if (k == c->out_count){
+        c->stats.unmatched++;
+        return;
+    }
+    while (k--) client_drop_head(c);
+
+    client_req_t req = c->outq[c->out_head];
+    client_pop(c);
+
+    switch (msg->cmd){
+        case PROTO_CMD_ACK:    c->stats.acked++; break;
+        case PROTO_CMD_NACK:   c->stats.nacked++; break;
+        case PROTO_CMD_STAT:   c->stats.stats++; break;
+        case PROTO_CMD_CREDIT: c->stats.credits++; break;
+        default: break;
+    }
+    uint32_t lat = c->now_ms - req.sent_ms;
+    c->stats.lat_hist[lat < CLIENT_LAT_BUCKETS ? lat : CLIENT_LAT_BUCKETS - 1u]++;
+    if (c->on_reply) c->on_reply(c->ctx, &req, msg, lat);
+}
+// Strumieniowe dekodowanie bajtów od urządzenia (dowolne fragmenty) i dopasowanie odpowiedzi.
+void client_feed(client_t* c, const uint8_t* data, size_t len, uint32_t now_ms){
+    c->now_ms = now_ms;
+    size_t i = 0;
+    while (i < len){
+        // Porcjami o rozmiarze wolnego miejsca w RX — bez gubienia bajtów.
+        size_t room = rb_free(&c->rx);
+        size_t chunk = (len - i) < room ? (len - i) : room;
+        for (size_t j = 0; j < chunk; j++) (void)rb_put(&c->rx, data[i + j]);
+        i += chunk;
+        proto_poll(&c->proto, now_ms, client_on_msg, NULL, c);
+    }
+}
+// Obsługa timeoutów: FSM dekodera oraz żądania bez odpowiedzi dłużej niż CLIENT_REPLY_TIMEOUT_MS.
+void client_poll(client_t* c, uint32_t now_ms){
+    c->now_ms = now_ms;
+    proto_poll(&c->proto, now_ms, client_on_msg, NULL, c);
+    while (c->out_count > 0 && (now_ms - c->outq[c->out_head].sent_ms) > CLIENT_REPLY_TIMEOUT_MS){
+        client_drop_head(c);
+    }
+}
+// Percentyl opóźnienia (0..100) w ms na podstawie histogramu.
+uint32_t client_latency_pct(const client_t* c, unsigned pct){
+    uint64_t total = 0;
+    for (uint32_t i = 0; i < CLIENT_LAT_BUCKETS; i++) total += c->stats.lat_hist[i];
+    if (total == 0) return 0;
+    uint64_t want = (total * pct + 99u) / 100u;
+    if (want == 0) want = 1;
+    uint64_t acc = 0;
+    for (uint32_t i = 0; i < CLIENT_LAT_BUCKETS; i++){
+        acc += c->stats.lat_hist[i];
+        if (acc >= want) return i;
+    }
+    return CLIENT_LAT_BUCKETS - 1u;
+}
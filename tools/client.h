@@ -0,0 +1,88 @@
+#pragma once
+#include <stdint.h>
+#include <stddef.h>
+#include "ringbuf.h"
+#include "protocol.h"
+
+// Klient protokołu po stronie hosta: kodowanie żądań, dekodowanie odpowiedzi
+// (ten sam FSM co urządzenie — proto_poll) i dopasowanie odpowiedzi do żądań.
+//
+// Ograniczenie: odpowiedzi nie niosą identyfikatora żądania (STAT — żadnego, ACK/NACK — tylko CMD),
+// więc dopasowanie jest FIFO po typie. Gdy urządzenie zgubi odpowiedź (resp_dropped), kolejne
+// odpowiedzi tego typu trafiają do starszych żądań, a brak jest przypisany późniejszemu żądaniu.
+// Histogram opóźnień jest wtedy zniekształcony — wiarygodny tylko przy stats.lost == 0.
+
+// Maksymalna liczba żądań oczekujących na odpowiedź
+#ifndef CLIENT_MAX_OUTSTANDING
+#define CLIENT_MAX_OUTSTANDING 256u
+#endif
+// Po tym czasie żądanie bez odpowiedzi uznajemy za utracone
+#ifndef CLIENT_REPLY_TIMEOUT_MS
+#define CLIENT_REPLY_TIMEOUT_MS 500u
+#endif
+// Histogram opóźnień: koszyki po 1 ms, ostatni koszyk = przepełnienie
+#ifndef CLIENT_LAT_BUCKETS
+#define CLIENT_LAT_BUCKETS 512u
+#endif
+
+// Żądanie oczekujące na odpowiedź.
+typedef struct {
+    uint8_t cmd;
+    uint8_t corrupt;       // 1 = ramka celowo uszkodzona: odpowiedź opcjonalna (tylko NACK:CRC)
+    uint32_t sent_ms;
+} client_req_t;
+
+// Statystyki klienta.
+typedef struct {
+    uint32_t sent;
+    uint32_t acked;
+    uint32_t nacked;
+    uint32_t stats;
+    uint32_t credits;
+    uint32_t credit_updates;  // CREDIT wysłane przez urządzenie bez pytania
+    uint32_t lost;         // żądania bez odpowiedzi (pominięte lub po timeoucie)
+    uint32_t skipped;      // uszkodzone żądania bez odpowiedzi (oczekiwane, nie liczone jako lost)
+    uint32_t unmatched;    // odpowiedzi, do których nie pasuje żadne żądanie
+    uint32_t lat_hist[CLIENT_LAT_BUCKETS];
+} client_stats_t;
+
+// Callback wywoływany po dopasowaniu odpowiedzi do żądania. req == NULL: CREDIT wysłany przez urządzenie bez pytania.
+typedef void (*client_on_reply_fn)(void* ctx, const client_req_t* req, const proto_msg_t* reply, uint32_t latency_ms);
+
+// Struktura reprezentująca klienta.
+typedef struct {
+    rb_t rx;               // bajty od urządzenia
+    proto_t proto;         // tylko dekodowanie (bez TX)
+
+    client_req_t outq[CLIENT_MAX_OUTSTANDING];
+    size_t out_head, out_count;
+    uint32_t now_ms;
+
+    client_on_reply_fn on_reply;
+    void* ctx;
+
+    client_stats_t stats;
+} client_t;
+
+// Inicjalizacja klienta (on_reply może być NULL).
+void client_init(client_t* c, client_on_reply_fn on_reply, void* ctx);
+
+// Koduje kolejne żądania do jednego ciągłego bufora w jednym przebiegu i rejestruje je jako oczekujące.
+// Zwraca liczbę zakodowanych żądań (mniej niż n, gdy brak miejsca w out lub w kolejce), *out_len = liczba bajtów.
+size_t client_encode(client_t* c, const proto_msg_t* reqs, size_t n, uint8_t* out, size_t out_cap, size_t* out_len, uint32_t now_ms);
+
+// Oznacza żądanie jako celowo uszkodzone (back = 0: ostatnio zakodowane). Dopasowanie pominie je,
+// jeśli nie dostanie NACK:CRC, zamiast przesuwać kolejne odpowiedzi o jedno żądanie.
+void client_mark_corrupt(client_t* c, size_t back);
+
+// Strumieniowe dekodowanie bajtów od urządzenia (dowolne fragmenty) i dopasowanie odpowiedzi.
+void client_feed(client_t* c, const uint8_t* data, size_t len, uint32_t now_ms);
+
+// Obsługa timeoutów: FSM dekodera oraz żądania bez odpowiedzi dłużej niż CLIENT_REPLY_TIMEOUT_MS.
+void client_poll(client_t* c, uint32_t now_ms);
+
+// Liczba żądań oczekujących na odpowiedź.
+size_t client_outstanding(const client_t* c);
+
+// Percentyl opóźnienia (0..100) w ms na podstawie histogramu.
+uint32_t client_latency_pct(const client_t* c, unsigned pct);
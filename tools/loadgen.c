@@ -0,0 +1,227 @@
+// Generator obciążenia: klient protokołu (client.c) steruje symulowanym urządzeniem (shell.c)
+// przez łącze o ograniczonej przepustowości i raportuje przepustowość oraz opóźnienia.
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "shell.h"
+#include "client.h"
+
+// Parametry generatora (domyślnie: ~UART 115200 bodów, 1 tick = 1 ms).
+typedef struct {
+    uint32_t ticks;         // -d czas trwania (ms)
+    uint32_t rate;          // -r żądania na sekundę
+    uint32_t line;          // -l bajty host->urządzenie na tick
+    uint32_t window;        // -w maks. liczba żądań w locie (0 = bez limitu)
+    uint32_t credit;        // -c 1 = okno z ramek CREDIT urządzenia (GET_CREDIT + aktualizacje)
+    uint32_t err_pm;        // -e uszkodzone ramki na 1000
+    uint32_t frag;          // -f maks. fragment na tick (0 = bez fragmentacji)
+    uint32_t mix[4];        // -m wagi SET_SPEED,SET_MODE,STOP,GET_STAT
+    uint32_t seed;          // -s ziarno PRNG
+} loadgen_cfg_t;
+
+// Łącze host->urządzenie (bajty zakodowane, jeszcze nie dostarczone).
+#define LINK_CAP 4096u
+
+typedef struct {
+    shell_t sh;
+    client_t cl;
+    uint8_t link[LINK_CAP];
+    size_t link_len;
+    uint32_t now_ms;
+    uint32_t rng;
+    uint32_t injected;
+    uint32_t credit_window;  // ostatnio ogłoszone przez urządzenie kredyty (tryb -c 1)
+} loadgen_t;
+
+// Prosty PRNG (xorshift32) — powtarzalne przebiegi dla danego ziarna.
+static uint32_t rng_next(uint32_t* s){
+    uint32_t x = *s;
+    x ^= x << 13; x ^= x >> 17; x ^= x << 5;
+    return *s = x;
+}
+// Bajty TX urządzenia trafiają prosto do dekodera klienta.
+static void dev_tx_sink(void* ctx, const uint8_t* data, size_t len){
+    loadgen_t* lg = (loadgen_t*)ctx;
+    client_feed(&lg->cl, data, len, lg->now_ms);
+}
+// Odpowiedzi CREDIT (na GET_CREDIT lub bez pytania) ustawiają okno żądań w locie.
+static void on_reply(void* ctx, const client_req_t* req, const proto_msg_t* reply, uint32_t latency_ms){
+    loadgen_t* lg = (loadgen_t*)ctx;
+    (void)req;
+    (void)latency_ms;
+    if (reply->cmd == PROTO_CMD_CREDIT && reply->payload_len == 1u) lg->credit_window = reply->payload[0];
+}
+// Losuje żądanie według wag mieszanki komend.
+static void make_request(loadgen_t* lg, const loadgen_cfg_t* cfg, proto_msg_t* m){
+    static const uint8_t cmds[4] = { PROTO_CMD_SET_SPEED, PROTO_CMD_SET_MODE, PROTO_CMD_STOP, PROTO_CMD_GET_STAT };
+    uint32_t total = cfg->mix[0] + cfg->mix[1] + cfg->mix[2] + cfg->mix[3];
+    uint32_t r = rng_next(&lg->rng) % total;
+    unsigned k = 0;
+    while (r >= cfg->mix[k]) r -= cfg->mix[k++];
+    m->cmd = cmds[k];
+    m->payload_len = 0;
+    if (m->cmd == PROTO_CMD_SET_SPEED){
+        m->payload[0] = (uint8_t)(rng_next(&lg->rng) % 101u);
+        m->payload_len = 1;
+    } else if (m->cmd == PROTO_CMD_SET_MODE){
+        m->payload[0] = (uint8_t)(rng_next(&lg->rng) & 1u);
+        m->payload_len = 1;
+    }
+}
+// Generuje due żądań, koduje je jednym wywołaniem do łącza i wstrzykuje błędy. Zwraca liczbę wysłanych.
+static uint32_t send_batch(loadgen_t* lg, const loadgen_cfg_t* cfg, uint32_t due){
+    proto_msg_t reqs[64];
+    if (due > 64u) due = 64u;
+    uint32_t window = cfg->credit ? lg->credit_window : cfg->window;
+    if (window || cfg->credit){
+        size_t out = client_outstanding(&lg->cl);
+        uint32_t room = out >= window ? 0u : (uint32_t)(window - out);
+        if (due > room) due = room;
+    }
+    for (uint32_t i = 0; i < due; i++) make_request(lg, cfg, &reqs[i]);
+
+    size_t start = lg->link_len;
+    size_t bytes = 0;
+    size_t sent = client_encode(&lg->cl, reqs, due, &lg->link[start], LINK_CAP - start, &bytes, lg->now_ms);
+    lg->link_len += bytes;
+    // Wstrzykiwanie błędów: odwrócenie bajtu CMD/PAYLOAD/CRC w ramce żądania i. STX/LEN zostają
+    // nietknięte, więc urządzenie nie gubi synchronizacji i odpowiada dokładnie jednym NACK:CRC.
+    size_t off = start;
+    for (size_t i = 0; i < sent; i++){
+        size_t len = 1u + 1u + 1u + reqs[i].payload_len + 1u;
+        if ((rng_next(&lg->rng) % 1000u) < cfg->err_pm){
+            lg->link[off + 2u + rng_next(&lg->rng) % (len - 2u)] ^= 0xFFu;
+            client_mark_corrupt(&lg->cl, sent - 1u - i);
+            lg->injected++;
+        }
+        off += len;
+    }
+    return (uint32_t)sent;
+}
+// Przesyła do urządzenia najwyżej line bajtów (opcjonalnie losowy fragment 1..frag).
+static void link_deliver(loadgen_t* lg, const loadgen_cfg_t* cfg){
+    size_t n = lg->link_len < cfg->line ? lg->link_len : cfg->line;
+    if (cfg->frag && n > 1u){
+        size_t f = 1u + rng_next(&lg->rng) % cfg->frag;
+        if (f < n) n = f;
+    }
+    // Nie przepełniamy RX urządzenia — łącze wstrzymuje nadawanie (sprzętowa kontrola przepływu).
+    size_t room = rb_free(&lg->sh.rx);
+    if (n > room) n = room;
+    if (!n) return;
+    shell_rx_bytes(&lg->sh, lg->link, n);
+    memmove(lg->link, &lg->link[n], lg->link_len - n);
+    lg->link_len -= n;
+}
+// Jeden tick: generowanie, łącze, urządzenie, klient.
+static void step(loadgen_t* lg, const loadgen_cfg_t* cfg, uint32_t due){
+    lg->now_ms++;
+    if (due) (void)send_batch(lg, cfg, due);
+    link_deliver(lg, cfg);
+    shell_tick(&lg->sh);
+    client_poll(&lg->cl, lg->now_ms);
+}
+
+static void usage(const char* prog){
+    fprintf(stderr,
+        "usage: %s [-d ms] [-r req/s] [-l bytes/tick] [-w window] [-c 0|1] [-e err/1000] [-f frag] [-m set,mode,stop,stat] [-s seed]\n",
+        prog);
+}
+// Parsowanie argumentów. Zwraca 1 w przypadku sukcesu.
+static int parse_args(int argc, char** argv, loadgen_cfg_t* cfg){
+    for (int i = 1; i < argc; i++){
+        const char* a = argv[i];
+        if (a[0] != '-' || a[1] == '\0' || a[2] != '\0' || i + 1 >= argc) return 0;
+        const char* v = argv[++i];
+        char* end = NULL;
+        if (a[1] == 'm'){
+            for (unsigned k = 0; k < 4u; k++){
+                cfg->mix[k] = (uint32_t)strtoul(v, &end, 10);
+                if (end == v || (k < 3u && *end != ',')) return 0;
+                v = end + 1;
+            }
+            if (*end != '\0') return 0;
+            if (cfg->mix[0] + cfg->mix[1] + cfg->mix[2] + cfg->mix[3] == 0u) return 0;
+            continue;
+        }
+        uint32_t x = (uint32_t)strtoul(v, &end, 10);
+        if (end == v || *end != '\0') return 0;
+        switch (a[1]){
+            case 'd': cfg->ticks = x; break;
+            case 'r': cfg->rate = x; break;
+            case 'l': cfg->line = x; break;
+            case 'w': cfg->window = x; break;
+            case 'c': cfg->credit = x; break;
+            case 'e': cfg->err_pm = x; break;
+            case 'f': cfg->frag = x; break;
+            case 's': cfg->seed = x ? x : 1u; break;
+            default: return 0;
+        }
+    }
+    return cfg->line > 0u;
+}
+
+int main(int argc, char** argv){
+    loadgen_cfg_t cfg = {
+        .ticks = 10000u, .rate = 2000u, .line = 12u, .window = 0u, .credit = 0u,
+        .err_pm = 0u, .frag = 0u, .mix = { 4u, 1u, 1u, 2u }, .seed = 1u,
+    };
+    if (!parse_args(argc, argv, &cfg)){
+        usage(argv[0]);
+        return 2;
+    }
+
+    static loadgen_t lg;
+    shell_init(&lg.sh);
+    lg.sh.log_io = 0;
+    lg.sh.tx_sink = dev_tx_sink;
+    lg.sh.tx_sink_ctx = &lg;
+    client_init(&lg.cl, on_reply, &lg);
+    lg.rng = cfg.seed;
+    if (cfg.credit){
+        // Pierwsze okno z odpowiedzi na GET_CREDIT, kolejne z aktualizacji wysyłanych bez pytania.
+        proto_msg_t q = { .cmd = PROTO_CMD_GET_CREDIT, .payload_len = 0 };
+        size_t bytes = 0;
+        (void)client_encode(&lg.cl, &q, 1, lg.link, LINK_CAP, &bytes, lg.now_ms);
+        lg.link_len = bytes;
+        lg.sh.credit_updates = 1;
+    }
+
+    clock_t t0 = clock();
+    uint32_t acc = 0;
+    for (uint32_t t = 0; t < cfg.ticks; t++){
+        acc += cfg.rate;
+        uint32_t due = acc / 1000u;
+        acc %= 1000u;
+        step(&lg, &cfg, due);
+    }
+    // Dokończ: dostarcz resztę łącza i poczekaj na odpowiedzi (lub timeout klienta).
+    uint32_t drain = 0;
+    while ((lg.link_len || client_outstanding(&lg.cl)) && drain++ < CLIENT_REPLY_TIMEOUT_MS + 10u) step(&lg, &cfg, 0);
+    double cpu = (double)(clock() - t0) / CLOCKS_PER_SEC;
+
+    const client_stats_t* s = &lg.cl.stats;
+    uint32_t replies = s->acked + s->nacked + s->stats + s->credits;
+    double sim_s = (double)lg.now_ms / 1000.0;
+    printf("LOADGEN: ticks=%u rate=%u/s line=%uB/tick window=%u credit=%u err=%u/1000 frag=%u mix=%u,%u,%u,%u\n",
+        cfg.ticks, cfg.rate, cfg.line, cfg.credit ? lg.credit_window : cfg.window, cfg.credit, cfg.err_pm, cfg.frag, cfg.mix[0], cfg.mix[1], cfg.mix[2], cfg.mix[3]);
+    printf("CLIENT: sent=%u replies=%u ack=%u nack=%u stat=%u credit=%u+%u lost=%u skipped=%u unmatched=%u injected=%u\n",
+        s->sent, replies, s->acked, s->nacked, s->stats, s->credits, s->credit_updates, s->lost, s->skipped, s->unmatched, lg.injected);
+    printf("DEVICE: rx_dropped=%zu broken_frames=%u crc_errors=%u resp_deferred=%u resp_dropped=%u\n",
+        lg.sh.rx.dropped, lg.sh.proto.stats.broken_frames, lg.sh.proto.stats.crc_errors,
+        lg.sh.proto.stats.resp_deferred, lg.sh.proto.stats.resp_dropped);
+    printf("RATE: achieved=%.0f req/s (sim) cpu=%.3fs (%.0f req/s CPU)\n",
+        sim_s > 0.0 ? (double)replies / sim_s : 0.0, cpu, cpu > 0.0 ? (double)replies / cpu : 0.0);
+    // Przy zgubionych odpowiedziach dopasowanie FIFO przesuwa pary żądanie/odpowiedź (patrz client.h).
+    int unreliable = s->lost > 0u || lg.sh.proto.stats.resp_dropped > 0u;
+    printf("LATENCY%s: p50=%ums p90=%ums p99=%ums max=%ums\n", unreliable ? " (UNRELIABLE)" : "",
+        client_latency_pct(&lg.cl, 50), client_latency_pct(&lg.cl, 90),
+        client_latency_pct(&lg.cl, 99), client_latency_pct(&lg.cl, 100));
+    if (unreliable){
+        printf("WARN: lost=%u resp_dropped=%u — replies were paired FIFO without request ids; "
+            "percentiles are not round-trip latency (use -w/-c to avoid drops)\n",
+            s->lost, lg.sh.proto.stats.resp_dropped);
+    }
+    return 0;
+}